@@ -2,4 +2,8 @@ require 'mkmf'
 
 extension_name = 'rgss3'
 dir_config(extension_name)
+
+# Available since Ruby 2.4. Used to report table memory to the GC.
+have_func('rb_gc_adjust_memory_usage', 'ruby.h')
+
 create_makefile(extension_name)
@@ -3,8 +3,17 @@
 // Only the functionality required to make this gem work is implemented here.
 
 #include <stdio.h>
+#include <limits.h>
 #include <ruby.h>
 
+// Reports memory allocated outside of Ruby's heap to the garbage collector.
+// This lets the GC schedule itself based on the actual memory in use.
+#ifdef HAVE_RB_GC_ADJUST_MEMORY_USAGE
+#define ADJUST_MEMORY_USAGE(DIFF) rb_gc_adjust_memory_usage(DIFF)
+#else
+#define ADJUST_MEMORY_USAGE(DIFF)
+#endif
+
 /**
  * Table class
  */
@@ -15,6 +24,11 @@
 
 #define TABLE_INDEX(TABLE, X, Y, Z) FLAT_INDEX(X, Y, Z, TABLE->x, TABLE->y)
 
+#define TABLE_DATA_LEN(SIZE) (sizeof(signed short int) * (SIZE))
+
+// Retrieves a value from a hash decoded from JSON.
+#define JSON_ATTRIBUTE(HASH, NAME) rb_hash_aref(HASH, rb_str_new_cstr(NAME))
+
 struct table {
     int x, y, z;
     int size;
@@ -24,6 +38,8 @@ struct table {
 // Prototypes
 VALUE allocateTableClass(VALUE klass);
 void freeTableClass(void *tablePtr);
+size_t sizeTableClass(const void *tablePtr);
+void table_setData(struct table *table, int x, int y, int z, int size, signed short int *data);
 VALUE tableClass_initialize(int argc, VALUE *argv, VALUE self);
 VALUE tableClass_resize(int argc, VALUE *argv, VALUE self);
 VALUE tableClass_getXSize(VALUE self);
@@ -34,6 +50,16 @@ VALUE tableClass_setElement(int argc, VALUE *argv, VALUE self);
 // TODO: Marshaled data is stored as little-endian. Make sure to convert if needed.
 VALUE tableClass_load(VALUE tableClass, VALUE marshaled);
 VALUE tableClass_dump(VALUE self, VALUE level);
+VALUE tableClass_toJson(int argc, VALUE *argv, VALUE self);
+VALUE tableClass_jsonCreate(VALUE tableClass, VALUE hash);
+
+// Describes the Table class to the garbage collector.
+static const rb_data_type_t tableDataType = {
+    "rgss3/table",
+    { 0, freeTableClass, sizeTableClass, },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY
+};
 
 // Defines the Table class and its methods.
 void define_tableClass()
@@ -54,6 +80,10 @@ void define_tableClass()
     // Define special marshal methods.
     rb_define_singleton_method(tableClass, "_load", tableClass_load, 1);
     rb_define_method(tableClass, "_dump", tableClass_dump, 1);
+
+    // Define the JSON methods.
+    rb_define_singleton_method(tableClass, "json_create", tableClass_jsonCreate, 1);
+    rb_define_method(tableClass, "to_json", tableClass_toJson, -1);
 }
 
 // Implementation
@@ -61,14 +91,41 @@ void define_tableClass()
 VALUE allocateTableClass(VALUE klass)
 {
     struct table *table;
-    return Data_Make_Struct(klass, struct table, 0, freeTableClass, table);
+    return TypedData_Make_Struct(klass, struct table, &tableDataType, table);
 }
 
 void freeTableClass(void *tablePtr)
 {
     struct table *table = (struct table *)tablePtr;
+    if(table->data)
+        ADJUST_MEMORY_USAGE(-(ssize_t)TABLE_DATA_LEN(table->size));
     free(table->data);
-    free(table);
+    xfree(table);
+}
+
+size_t sizeTableClass(const void *tablePtr)
+{
+    const struct table *table = (const struct table *)tablePtr;
+    size_t dataLen = table->data ? TABLE_DATA_LEN(table->size) : 0;
+    return sizeof(struct table) + dataLen;
+}
+
+// Replaces the dimensions and contents of a table.
+// The table takes ownership of the data and frees its previous contents.
+// The change in size is reported to the garbage collector.
+void table_setData(struct table *table, int x, int y, int z, int size, signed short int *data)
+{
+    signed short int *prevData = table->data;
+    ssize_t prevLen = prevData ? (ssize_t)TABLE_DATA_LEN(table->size) : 0;
+
+    table->x    = x;
+    table->y    = y;
+    table->z    = z;
+    table->size = size;
+    table->data = data;
+
+    free(prevData);
+    ADJUST_MEMORY_USAGE((ssize_t)TABLE_DATA_LEN(size) - prevLen);
 }
 
 VALUE tableClass_initialize(int argc, VALUE *argv, VALUE self)
@@ -78,20 +135,16 @@ VALUE tableClass_initialize(int argc, VALUE *argv, VALUE self)
 
     if(rb_scan_args(argc, argv, "12", &xsize, &ysize, &zsize))
     {// xsize [, ysize [, zsize]]
-        Data_Get_Struct(self, struct table, table);
+        TypedData_Get_Struct(self, struct table, &tableDataType, table);
         int x = NUM2INT(xsize);
         int y = NIL_P(ysize) ? 1 : NUM2INT(ysize);
         int z = NIL_P(zsize) ? 1 : NUM2INT(zsize);
         int size = x * y * z;
-        int dataLen = sizeof(signed short int) * size;
+        int dataLen = TABLE_DATA_LEN(size);
         signed short int *data = (signed short int *)malloc(dataLen);
         memset(data, 0, dataLen);
 
-        table->x    = x;
-        table->y    = y;
-        table->z    = z;
-        table->size = size;
-        table->data = data;
+        table_setData(table, x, y, z, size, data);
     }
 
      return self;
@@ -104,12 +157,12 @@ VALUE tableClass_resize(int argc, VALUE *argv, VALUE self)
 
     if(rb_scan_args(argc, argv, "12", &xsize, &ysize, &zsize))
     {// xsize [, ysize [, zsize]]
-        Data_Get_Struct(self, struct table, table);
+        TypedData_Get_Struct(self, struct table, &tableDataType, table);
         int newX = NUM2INT(xsize);
         int newY = NIL_P(ysize) ? 1 : NUM2INT(ysize);
         int newZ = NIL_P(zsize) ? 1 : NUM2INT(zsize);
         int newSize = newX * newY * newZ;
-        int dataLen = sizeof(signed short int) * newSize;
+        int dataLen = TABLE_DATA_LEN(newSize);
         signed short int *newData = (signed short int *)malloc(dataLen);
         memset(newData, 0, dataLen);
 
@@ -123,7 +176,7 @@ VALUE tableClass_resize(int argc, VALUE *argv, VALUE self)
         int minZ = prevZ < newZ ? prevZ : newZ;
 
         int y, z;
-        int rowSize = minX * sizeof(signed short int);
+        int rowSize = TABLE_DATA_LEN(minX);
         for(z = 0; z < minZ; ++z)
             for(y = 0; y < minY; ++y)
             {
@@ -132,13 +185,7 @@ VALUE tableClass_resize(int argc, VALUE *argv, VALUE self)
                 memcpy(&newData[destIndex], &prevData[srcIndex], rowSize);
             }
 
-        table->x    = newX;
-        table->y    = newY;
-        table->z    = newZ;
-        table->size = newSize;
-        table->data = newData;
-
-        free(prevData);
+        table_setData(table, newX, newY, newZ, newSize, newData);
     }
 
     return self;
@@ -147,28 +194,28 @@ VALUE tableClass_resize(int argc, VALUE *argv, VALUE self)
 VALUE tableClass_getXSize(VALUE self)
 {
     struct table *table;
-    Data_Get_Struct(self, struct table, table);
+    TypedData_Get_Struct(self, struct table, &tableDataType, table);
     return INT2FIX(table->x);
 }
 
 VALUE tableClass_getYSize(VALUE self)
 {
     struct table *table;
-    Data_Get_Struct(self, struct table, table);
+    TypedData_Get_Struct(self, struct table, &tableDataType, table);
     return INT2FIX(table->y);
 }
 
 VALUE tableClass_getZSize(VALUE self)
 {
     struct table *table;
-    Data_Get_Struct(self, struct table, table);
+    TypedData_Get_Struct(self, struct table, &tableDataType, table);
     return INT2FIX(table->z);
 }
 
 VALUE tableClass_getElement(int argc, VALUE *argv, VALUE self)
 {
     struct table *table;
-    Data_Get_Struct(self, struct table, table);
+    TypedData_Get_Struct(self, struct table, &tableDataType, table);
 
     VALUE xval, yval, zval;
     if(rb_scan_args(argc, argv, "12", &xval, &yval, &zval))
@@ -186,7 +233,7 @@ VALUE tableClass_getElement(int argc, VALUE *argv, VALUE self)
 VALUE tableClass_setElement(int argc, VALUE *argv, VALUE self)
 {
     struct table *table;
-    Data_Get_Struct(self, struct table, table);
+    TypedData_Get_Struct(self, struct table, &tableDataType, table);
 
     VALUE val1, val2, val3, val4;
     int value;
@@ -230,40 +277,96 @@ VALUE tableClass_load(VALUE tableClass, VALUE marshaled)
     memcpy(&size,    &marshaledBytes[16], 4);
     // TODO: Assert version == 2
     // TODO: Assert size == xsize * ysize * zsize
-    int dataLen = sizeof(signed short int) * size;
+    int dataLen = TABLE_DATA_LEN(size);
     signed short int *data = (signed short int *)malloc(dataLen);
     memcpy(data, &marshaledBytes[20], dataLen);
 
     VALUE self = allocateTableClass(tableClass);
     struct table *table;
-    Data_Get_Struct(self, struct table, table);
-    table->x    = xsize;
-    table->y    = ysize;
-    table->z    = zsize;
-    table->size = size;
-    table->data = data;
+    TypedData_Get_Struct(self, struct table, &tableDataType, table);
+    table_setData(table, xsize, ysize, zsize, size, data);
     return self;
 }
 
 VALUE tableClass_dump(VALUE self, VALUE level)
 {
     struct table *table;
-    Data_Get_Struct(self, struct table, table);
+    TypedData_Get_Struct(self, struct table, &tableDataType, table);
     int version = TABLE_MARSHAL_VERSION;
     int xsize   = table->x;
     int ysize   = table->y;
     int zsize   = table->z;
     int size    = table->size;
-    int dataLen = sizeof(signed short int) * size;
+    int dataLen = TABLE_DATA_LEN(size);
     int marshalLen = dataLen + 20;
-    char *marshaledBytes = (char *)malloc(marshalLen);
+    // Write directly into the string's buffer to avoid a temporary copy.
+    VALUE marshaled = rb_str_new(NULL, marshalLen);
+    char *marshaledBytes = RSTRING_PTR(marshaled);
     memcpy(&marshaledBytes[0],  &version,    4);
     memcpy(&marshaledBytes[4],  &xsize,      4);
     memcpy(&marshaledBytes[8],  &ysize,      4);
     memcpy(&marshaledBytes[12], &zsize,      4);
     memcpy(&marshaledBytes[16], &size,       4);
     memcpy(&marshaledBytes[20], table->data, dataLen);
-    return rb_str_new(marshaledBytes, marshalLen);
+    return marshaled;
+}
+
+VALUE tableClass_toJson(int argc, VALUE *argv, VALUE self)
+{
+    struct table *table;
+    TypedData_Get_Struct(self, struct table, &tableDataType, table);
+
+    // Each element is at most 7 characters ("-32768,").
+    VALUE json = rb_str_buf_new(128 + table->size * 7);
+    char buffer[128];
+    int i, len;
+    len = snprintf(buffer, sizeof(buffer),
+                   "{\"json_class\":\"Table\",\"xsize\":%d,\"ysize\":%d,\"zsize\":%d,\"data\":[",
+                   table->x, table->y, table->z);
+    rb_str_buf_cat(json, buffer, len);
+    for(i = 0; i < table->size; ++i)
+    {
+        len = snprintf(buffer, sizeof(buffer), i ? ",%d" : "%d", table->data[i]);
+        rb_str_buf_cat(json, buffer, len);
+    }
+    rb_str_buf_cat(json, "]}", 2);
+    return json;
+}
+
+VALUE tableClass_jsonCreate(VALUE tableClass, VALUE hash)
+{
+    Check_Type(hash, T_HASH);
+    int xsize = NUM2INT(JSON_ATTRIBUTE(hash, "xsize"));
+    int ysize = NUM2INT(JSON_ATTRIBUTE(hash, "ysize"));
+    int zsize = NUM2INT(JSON_ATTRIBUTE(hash, "zsize"));
+    VALUE values = JSON_ATTRIBUTE(hash, "data");
+    Check_Type(values, T_ARRAY);
+    if(xsize < 0 || ysize < 0 || zsize < 0)
+        rb_raise(rb_eArgError, "Table dimensions must not be negative");
+
+    // The size in bytes must also fit in an int, since that's what the marshal methods use.
+    long long product = (long long)xsize * ysize;
+    if(product > INT_MAX || (product *= zsize) > (long long)(INT_MAX / sizeof(signed short int)))
+        rb_raise(rb_eRangeError, "Table dimensions are too large");
+    int size = (int)product;
+    if(RARRAY_LEN(values) != size)
+        rb_raise(rb_eArgError, "Table data length does not match its dimensions");
+
+    // Attach the data to the table before filling it in,
+    // so that it is not leaked if a value fails to convert.
+    int dataLen = TABLE_DATA_LEN(size);
+    signed short int *data = (signed short int *)malloc(dataLen);
+    memset(data, 0, dataLen);
+
+    VALUE self = allocateTableClass(tableClass);
+    struct table *table;
+    TypedData_Get_Struct(self, struct table, &tableDataType, table);
+    table_setData(table, xsize, ysize, zsize, size, data);
+
+    int i;
+    for(i = 0; i < size; ++i)
+        data[i] = NUM2SHORT(RARRAY_AREF(values, i));
+    return self;
 }
 
 /**
@@ -272,7 +375,7 @@ VALUE tableClass_dump(VALUE self, VALUE level)
 
 #define GET_TONE_VALUE(C) \
     struct tone *tone; \
-    Data_Get_Struct(self, struct tone, tone); \
+    TypedData_Get_Struct(self, struct tone, &toneDataType, tone); \
     return INT2FIX(tone->C)
 
 #define CORRECT_TONE_VALUE(C, X, TONE) \
@@ -293,17 +396,18 @@ VALUE tableClass_dump(VALUE self, VALUE level)
 
 #define SET_TONE_VALUE(C, X) \
     struct tone *tone; \
-    Data_Get_Struct(self, struct tone, tone); \
+    TypedData_Get_Struct(self, struct tone, &toneDataType, tone); \
     CORRECT_TONE_VALUE(C, X, tone); \
     return INT2FIX(C)
 
 struct tone {
-    unsigned short int r, g, b;
+    signed short int r, g, b;
     unsigned char a;
 };
 
 // Prototypes
 VALUE allocateToneClass(VALUE klass);
+size_t sizeToneClass(const void *tonePtr);
 VALUE toneClass_setValues(int argc, VALUE *argv, VALUE self);
 VALUE toneClass_initialize(int argc, VALUE *argv, VALUE self);
 VALUE toneClass_set(int argc, VALUE *argv, VALUE self);
@@ -318,6 +422,16 @@ VALUE toneClass_setGray(VALUE self, VALUE value);
 // TODO: Marshaled data is stored as little-endian
 VALUE toneClass_load(VALUE toneClass, VALUE marshaled);
 VALUE toneClass_dump(VALUE self, VALUE level);
+VALUE toneClass_toJson(int argc, VALUE *argv, VALUE self);
+VALUE toneClass_jsonCreate(VALUE toneClass, VALUE hash);
+
+// Describes the Tone class to the garbage collector.
+static const rb_data_type_t toneDataType = {
+    "rgss3/tone",
+    { 0, RUBY_TYPED_DEFAULT_FREE, sizeToneClass, },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY
+};
 
 // Defines the Tone class and its methods.
 void define_toneClass()
@@ -341,6 +455,10 @@ void define_toneClass()
     // Define the marshal methods.
     rb_define_singleton_method(toneClass, "_load", toneClass_load, 1);
     rb_define_method(toneClass, "_dump", toneClass_dump, 1);
+
+    // Define the JSON methods.
+    rb_define_singleton_method(toneClass, "json_create", toneClass_jsonCreate, 1);
+    rb_define_method(toneClass, "to_json", toneClass_toJson, -1);
 }
 
 // Implementation
@@ -348,7 +466,12 @@ void define_toneClass()
 VALUE allocateToneClass(VALUE klass)
 {
     struct tone *tone;
-    return Data_Make_Struct(klass, struct tone, 0, -1, tone);
+    return TypedData_Make_Struct(klass, struct tone, &toneDataType, tone);
+}
+
+size_t sizeToneClass(const void *tonePtr)
+{
+    return sizeof(struct tone);
 }
 
 VALUE toneClass_setValues(int argc, VALUE *argv, VALUE self)
@@ -358,7 +481,7 @@ VALUE toneClass_setValues(int argc, VALUE *argv, VALUE self)
 
     if(rb_scan_args(argc, argv, "31", &red, &green, &blue, &gray))
     {// red, green, blue [, gray]
-        Data_Get_Struct(self, struct tone, tone);
+        TypedData_Get_Struct(self, struct tone, &toneDataType, tone);
         CORRECT_TONE_VALUE(r, red,   tone);
         CORRECT_TONE_VALUE(g, green, tone);
         CORRECT_TONE_VALUE(b, blue,  tone);
@@ -384,8 +507,8 @@ VALUE toneClass_set(int argc, VALUE *argv, VALUE self)
     if(argc == 1)
     {// set(tone)
         struct tone *tone, *other;
-        Data_Get_Struct(self, struct tone, tone);
-        Data_Get_Struct(argv[0], struct tone, other);
+        TypedData_Get_Struct(self, struct tone, &toneDataType, tone);
+        TypedData_Get_Struct(argv[0], struct tone, &toneDataType, other);
 
         tone->r = other->r;
         tone->g = other->g;
@@ -437,7 +560,7 @@ VALUE toneClass_getGray(VALUE self)
 VALUE toneClass_setGray(VALUE self, VALUE value)
 {
     struct tone *tone;
-    Data_Get_Struct(self, struct tone, tone);
+    TypedData_Get_Struct(self, struct tone, &toneDataType, tone);
     CORRECT_GRAY_VALUE(value, tone);
     return INT2FIX(a);
 }
@@ -453,14 +576,14 @@ VALUE toneClass_load(VALUE toneClass, VALUE marshaled)
     memcpy(&blue,  &marshaledBytes[16], 8);
     memcpy(&gray,  &marshaledBytes[24], 8);
     // TODO: Assert values are -255 to 255 and 0 to 255 for gray
-    unsigned short int r = (unsigned short int)red;
-    unsigned short int g = (unsigned short int)green;
-    unsigned short int b = (unsigned short int)blue;
-    unsigned char      a = (unsigned char)gray;
+    signed short int r = (signed short int)red;
+    signed short int g = (signed short int)green;
+    signed short int b = (signed short int)blue;
+    unsigned char    a = (unsigned char)gray;
 
     VALUE self = allocateToneClass(toneClass);
     struct tone *tone;
-    Data_Get_Struct(self, struct tone, tone);
+    TypedData_Get_Struct(self, struct tone, &toneDataType, tone);
     tone->r = r;
     tone->g = g;
     tone->b = b;
@@ -471,13 +594,13 @@ VALUE toneClass_load(VALUE toneClass, VALUE marshaled)
 VALUE toneClass_dump(VALUE self, VALUE level)
 {
     struct tone *tone;
-    Data_Get_Struct(self, struct tone, tone);
+    TypedData_Get_Struct(self, struct tone, &toneDataType, tone);
     double r = (double)tone->r;
     double g = (double)tone->g;
     double b = (double)tone->b;
     double a = (double)tone->a;
     int dataLen = sizeof(double) * 4;
-    char *marshaledBytes = (char *)malloc(dataLen);
+    char marshaledBytes[sizeof(double) * 4];
     memcpy(&marshaledBytes[0],  &r, 8);
     memcpy(&marshaledBytes[8],  &g, 8);
     memcpy(&marshaledBytes[16], &b, 8);
@@ -485,13 +608,37 @@ VALUE toneClass_dump(VALUE self, VALUE level)
     return rb_str_new(marshaledBytes, dataLen);
 }
 
+VALUE toneClass_toJson(int argc, VALUE *argv, VALUE self)
+{
+    struct tone *tone;
+    TypedData_Get_Struct(self, struct tone, &toneDataType, tone);
+    char buffer[128];
+    int len = snprintf(buffer, sizeof(buffer),
+                       "{\"json_class\":\"Tone\",\"red\":%d,\"green\":%d,\"blue\":%d,\"gray\":%d}",
+                       tone->r, tone->g, tone->b, tone->a);
+    return rb_str_new(buffer, len);
+}
+
+VALUE toneClass_jsonCreate(VALUE toneClass, VALUE hash)
+{
+    Check_Type(hash, T_HASH);
+    VALUE values[4];
+    values[0] = JSON_ATTRIBUTE(hash, "red");
+    values[1] = JSON_ATTRIBUTE(hash, "green");
+    values[2] = JSON_ATTRIBUTE(hash, "blue");
+    values[3] = JSON_ATTRIBUTE(hash, "gray");
+
+    VALUE self = allocateToneClass(toneClass);
+    return toneClass_setValues(4, values, self);
+}
+
 /**
  * Color class
  */
 
 #define GET_COLOR_VALUE(C) \
     struct color *color; \
-    Data_Get_Struct(self, struct color, color); \
+    TypedData_Get_Struct(self, struct color, &colorDataType, color); \
     return INT2FIX(color->C)
 
 #define CORRECT_COLOR_VALUE(C, X, COLOR) ; \
@@ -504,7 +651,7 @@ VALUE toneClass_dump(VALUE self, VALUE level)
 
 #define SET_COLOR_VALUE(C, X) \
     struct color *color; \
-    Data_Get_Struct(self, struct color, color); \
+    TypedData_Get_Struct(self, struct color, &colorDataType, color); \
     CORRECT_COLOR_VALUE(C, X, color); \
     return INT2FIX(C)
 
@@ -514,6 +661,7 @@ struct color {
 
 // Prototypes
 VALUE allocateColorClass(VALUE klass);
+size_t sizeColorClass(const void *colorPtr);
 VALUE colorClass_setValues(int argc, VALUE *argv, VALUE self);
 VALUE colorClass_init(int argc, VALUE *argv, VALUE self);
 VALUE colorClass_set(int argc, VALUE *argv, VALUE self);
@@ -528,19 +676,34 @@ VALUE colorClass_setAlpha(VALUE self, VALUE value);
 // TODO: Marshaled data is stored as little-endian
 VALUE colorClass_load (VALUE colorClass, VALUE marshaled);
 VALUE colorClass_dump(VALUE self, VALUE level);
+VALUE colorClass_toJson(int argc, VALUE *argv, VALUE self);
+VALUE colorClass_jsonCreate(VALUE colorClass, VALUE hash);
+
+// Describes the Color class to the garbage collector.
+static const rb_data_type_t colorDataType = {
+    "rgss3/color",
+    { 0, RUBY_TYPED_DEFAULT_FREE, sizeColorClass, },
+    0, 0,
+    RUBY_TYPED_FREE_IMMEDIATELY
+};
 
 // Implementation
 
 VALUE allocateColorClass(VALUE klass)
 {
     struct color *color;
-    return Data_Make_Struct(klass, struct color, 0, -1, color);
+    return TypedData_Make_Struct(klass, struct color, &colorDataType, color);
+}
+
+size_t sizeColorClass(const void *colorPtr)
+{
+    return sizeof(struct color);
 }
 
 VALUE colorClass_setValues(int argc, VALUE *argv, VALUE self)
 {
     struct color *color;
-    Data_Get_Struct(self, struct color, color);
+    TypedData_Get_Struct(self, struct color, &colorDataType, color);
     color->a = 255;
 
     VALUE red, green, blue, alpha;
@@ -570,8 +733,8 @@ VALUE colorClass_set(int argc, VALUE *argv, VALUE self)
     if(argc == 1)
     {// set(color)
         struct color *color, *other;
-        Data_Get_Struct(self, struct color, color);
-        Data_Get_Struct(argv[0], struct color, other);
+        TypedData_Get_Struct(self, struct color, &colorDataType, color);
+        TypedData_Get_Struct(argv[0], struct color, &colorDataType, other);
 
         color->r = other->r;
         color->g = other->g;
@@ -643,7 +806,7 @@ VALUE colorClass_load(VALUE colorClass, VALUE marshaled)
 
     VALUE self = allocateColorClass(colorClass);
     struct color *color;
-    Data_Get_Struct(self, struct color, color);
+    TypedData_Get_Struct(self, struct color, &colorDataType, color);
     color->r = r;
     color->g = g;
     color->b = b;
@@ -654,13 +817,13 @@ VALUE colorClass_load(VALUE colorClass, VALUE marshaled)
 VALUE colorClass_dump(VALUE self, VALUE level)
 {
     struct color *color;
-    Data_Get_Struct(self, struct color, color);
+    TypedData_Get_Struct(self, struct color, &colorDataType, color);
     double r = (double)color->r;
     double g = (double)color->g;
     double b = (double)color->b;
     double a = (double)color->a;
     int dataLen = sizeof(double) * 4;
-    char *marshaledBytes = (char *)malloc(dataLen);
+    char marshaledBytes[sizeof(double) * 4];
     memcpy(&marshaledBytes[0],  &r, 8);
     memcpy(&marshaledBytes[8],  &g, 8);
     memcpy(&marshaledBytes[16], &b, 8);
@@ -668,6 +831,30 @@ VALUE colorClass_dump(VALUE self, VALUE level)
     return rb_str_new(marshaledBytes, dataLen);
 }
 
+VALUE colorClass_toJson(int argc, VALUE *argv, VALUE self)
+{
+    struct color *color;
+    TypedData_Get_Struct(self, struct color, &colorDataType, color);
+    char buffer[128];
+    int len = snprintf(buffer, sizeof(buffer),
+                       "{\"json_class\":\"Color\",\"red\":%d,\"green\":%d,\"blue\":%d,\"alpha\":%d}",
+                       color->r, color->g, color->b, color->a);
+    return rb_str_new(buffer, len);
+}
+
+VALUE colorClass_jsonCreate(VALUE colorClass, VALUE hash)
+{
+    Check_Type(hash, T_HASH);
+    VALUE values[4];
+    values[0] = JSON_ATTRIBUTE(hash, "red");
+    values[1] = JSON_ATTRIBUTE(hash, "green");
+    values[2] = JSON_ATTRIBUTE(hash, "blue");
+    values[3] = JSON_ATTRIBUTE(hash, "alpha");
+
+    VALUE self = allocateColorClass(colorClass);
+    return colorClass_setValues(4, values, self);
+}
+
 // Defines the Color class and its methods.
 void define_colorClass()
 {
@@ -690,6 +877,10 @@ void define_colorClass()
     // Define the marshal methods.
     rb_define_singleton_method(colorClass, "_load", colorClass_load, 1);
     rb_define_method(colorClass, "_dump", colorClass_dump, 1);
+
+    // Define the JSON methods.
+    rb_define_singleton_method(colorClass, "json_create", colorClass_jsonCreate, 1);
+    rb_define_method(colorClass, "to_json", colorClass_toJson, -1);
 }
 
 /**
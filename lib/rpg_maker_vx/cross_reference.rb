@@ -0,0 +1,335 @@
+module RPGMakerVX
+
+  # Reverse-reference index over a database.
+  # Maps RPG IDs (skills, items, weapons, armors, states, switches, and variables)
+  # to the objects and event commands that reference them.
+  # The index is kept up-to-date as items are added to and removed from the database's collections.
+  class CrossReference
+
+    # Types of IDs that are indexed.
+    KINDS = [:skill, :item, :weapon, :armor, :state, :switch, :variable].freeze
+
+    # Single use of an ID.
+    # @!attribute [r] collection
+    #   @return [Symbol] Name of the database collection containing the referencing object, such as +:actors+.
+    # @!attribute [r] item
+    #   @return Object in the collection that contains the reference.
+    # @!attribute [r] command
+    #   @return [::RPG::EventCommand, nil] Event command containing the reference,
+    #     or +nil+ if the reference is an attribute of the item itself.
+    Reference = Struct.new(:collection, :item, :command)
+
+    # Index keys produced by an item, and the number of collection slots holding the item.
+    Source = Struct.new(:keys, :count)
+    private_constant :Source
+
+    # Feature codes that reference other database entries.
+    FEATURE_KINDS = {
+        13 => :state, # State rate
+        14 => :state, # State resist
+        32 => :state, # Attack state
+        43 => :skill, # Add skill
+        44 => :skill  # Seal skill
+    }.freeze
+
+    # Effect codes that reference other database entries.
+    EFFECT_KINDS = {
+        21 => :state, # Add state
+        22 => :state, # Remove state
+        43 => :skill  # Learn skill
+    }.freeze
+
+    # Kinds of items that can be dropped by enemies or sold in shops, ordered by their type number.
+    GOODS_KINDS = [:item, :weapon, :armor].freeze
+
+    # Feature code for special equipment slots.
+    SLOT_TYPE_FEATURE = 55
+
+    # Creates an index over a database.
+    # @param database [Database] Database to index.
+    # @note The entire database is scanned once when the index is created.
+    def initialize(database)
+      @database = database
+      @index    = Hash.new { |hash, key| hash[key] = [] }
+      @sources  = {}.compare_by_identity
+
+      Database::COLLECTION_TYPE_MAP.each_key do |key|
+        collection = database.send(key)
+        collection.each do |item|
+          add_item(key, item)
+        end
+        collection.on_change do |old_item, new_item|
+          remove_item(old_item) unless old_item.nil?
+          add_item(key, new_item) unless new_item.nil?
+        end
+      end
+    end
+
+    # Retrieves everything that references an ID.
+    # @param kind [Symbol] Type of ID to look up. Must be one of {KINDS}.
+    # @param id [Fixnum] ID to look up.
+    # @return [Array<Reference>] Objects and commands referencing the ID.
+    def references(kind, id)
+      fail ArgumentError, "Unknown reference kind #{kind.inspect}" unless KINDS.include?(kind)
+      refs = @index.fetch([kind, id], nil)
+      refs ? refs.dup : []
+    end
+
+    # Checks whether anything references an ID.
+    # @param kind [Symbol] Type of ID to look up. Must be one of {KINDS}.
+    # @param id [Fixnum] ID to look up.
+    # @return [Boolean] +true+ if at least one object or command references the ID.
+    def referenced?(kind, id)
+      fail ArgumentError, "Unknown reference kind #{kind.inspect}" unless KINDS.include?(kind)
+      @index.key?([kind, id])
+    end
+
+    # Re-scans a single item.
+    # Use this after changing an item's attributes in place, since those changes aren't reported by its collection.
+    # @param collection [Symbol] Name of the database collection containing the item, such as +:actors+.
+    # @param item Item to re-scan.
+    # @return [void]
+    def refresh(collection, item)
+      source = @sources[item]
+      return if source.nil?
+      unindex_item(item, source.keys)
+      source.keys = index_item(collection, item)
+      nil
+    end
+
+    private
+
+    # Records that an item was placed in a collection slot.
+    # An item is only scanned the first time it is added, even if it occupies several slots.
+    # @param collection [Symbol] Name of the collection containing the item.
+    # @param item Item that was added.
+    # @return [void]
+    def add_item(collection, item)
+      source = @sources[item]
+      if source
+        source.count += 1
+      else
+        @sources[item] = Source.new(index_item(collection, item), 1)
+      end
+    end
+
+    # Records that an item was removed from a collection slot.
+    # Its references are removed once no slots hold the item.
+    # @param item Item that was removed.
+    # @return [void]
+    def remove_item(item)
+      source = @sources[item]
+      return if source.nil?
+      source.count -= 1
+      return if source.count > 0
+      @sources.delete(item)
+      unindex_item(item, source.keys)
+    end
+
+    # Adds all of the references from an item to the index.
+    # @param collection [Symbol] Name of the collection containing the item.
+    # @param item Item to scan.
+    # @return [Array<Array>] Index keys that the item was added under.
+    def index_item(collection, item)
+      keys = []
+      scan_item(item) do |kind, id, command|
+        next unless id.is_a?(Integer) && id > 0
+        key = [kind, id]
+        @index[key] << Reference.new(collection, item, command)
+        keys << key
+      end
+      keys.uniq
+    end
+
+    # Removes all of the references from an item from the index.
+    # @param item Item that was previously scanned.
+    # @param keys [Array<Array>] Index keys that the item was added under.
+    # @return [void]
+    def unindex_item(item, keys)
+      keys.each do |key|
+        refs = @index[key]
+        refs.reject! { |ref| ref.item.equal?(item) }
+        @index.delete(key) if refs.empty?
+      end
+    end
+
+    # Finds all of the IDs referenced by an item.
+    # @param item Item to scan.
+    # @yieldparam kind [Symbol] Type of the referenced ID.
+    # @yieldparam id [Fixnum] Referenced ID.
+    # @yieldparam command [::RPG::EventCommand, nil] Event command containing the reference, if any.
+    # @return [void]
+    def scan_item(item, &block)
+      scan_features(item.features, &block) if item.respond_to?(:features)
+      scan_effects(item.effects, &block)   if item.respond_to?(:effects)
+
+      case item
+        when ::RPG::Actor
+          scan_equips(item, &block)
+        when ::RPG::Class
+          item.learnings.each do |learning|
+            yield :skill, learning.skill_id, nil
+          end
+        when ::RPG::Enemy
+          scan_enemy(item, &block)
+        when ::RPG::Troop
+          item.pages.each do |page|
+            condition = page.condition
+            yield :switch, condition.switch_id, nil if condition.switch_valid
+            scan_commands(page.list, &block)
+          end
+        when ::RPG::CommonEvent
+          yield :switch, item.switch_id, nil if item.trigger > 0
+          scan_commands(item.list, &block)
+      end
+    end
+
+    # Finds IDs referenced by a list of features.
+    def scan_features(features)
+      features.each do |feature|
+        kind = FEATURE_KINDS[feature.code]
+        yield kind, feature.data_id, nil if kind
+      end
+    end
+
+    # Finds IDs referenced by a list of effects.
+    def scan_effects(effects)
+      effects.each do |effect|
+        kind = EFFECT_KINDS[effect.code]
+        yield kind, effect.data_id, nil if kind
+      end
+    end
+
+    # Finds IDs referenced by an actor's initial equipment.
+    # The first slot is always a weapon, and the second is a weapon if the actor can dual wield.
+    def scan_equips(actor)
+      actor.equips.each_with_index do |id, slot|
+        yield equip_kind(actor, slot), id, nil
+      end
+    end
+
+    # Determines whether an equipment slot holds a weapon or armor.
+    # @param actor [::RPG::Actor, nil] Actor the slot belongs to.
+    # @param slot [Fixnum] Index of the equipment slot.
+    # @return [Symbol] +:weapon+ or +:armor+.
+    def equip_kind(actor, slot)
+      dual_wield = !actor.nil? && actor.features.any? { |feature| feature.code == SLOT_TYPE_FEATURE && feature.data_id == 1 }
+      (slot == 0 || (slot == 1 && dual_wield)) ? :weapon : :armor
+    end
+
+    # Finds IDs referenced by an enemy's actions and drops.
+    def scan_enemy(enemy)
+      enemy.actions.each do |action|
+        yield :skill, action.skill_id, nil
+        case action.condition_type
+          when 4 # State
+            yield :state, action.condition_param1.to_i, nil
+          when 6 # Switch
+            yield :switch, action.condition_param1.to_i, nil
+        end
+      end
+      enemy.drop_items.each do |drop|
+        next unless drop.kind > 0 # No drop
+        kind = GOODS_KINDS[drop.kind - 1]
+        yield kind, drop.data_id, nil if kind
+      end
+    end
+
+    # Finds IDs referenced by a list of event commands.
+    def scan_commands(list)
+      list.each do |command|
+        command_references(command.code, command.parameters) do |kind, id|
+          yield kind, id, command
+        end
+      end
+    end
+
+    # Finds IDs referenced by a single event command.
+    # @param code [Fixnum] Event command code.
+    # @param params [Array] Parameters of the command.
+    # @yieldparam kind [Symbol] Type of the referenced ID.
+    # @yieldparam id [Fixnum] Referenced ID.
+    # @return [void]
+    def command_references(code, params)
+      case code
+        when 103, 104 # Input number, select key item
+          yield :variable, params[0]
+        when 111 # Conditional branch
+          case params[0]
+            when 0 # Switch
+              yield :switch, params[1]
+            when 1 # Variable
+              yield :variable, params[1]
+              yield :variable, params[3] if params[2] != 0
+            when 4 # Actor
+              case params[2]
+                when 3 then yield :skill,  params[3]
+                when 4 then yield :weapon, params[3]
+                when 5 then yield :armor,  params[3]
+                when 6 then yield :state,  params[3]
+              end
+            when 5 # Enemy
+              yield :state, params[3] if params[2] == 1
+            when 8  then yield :item,   params[1]
+            when 9  then yield :weapon, params[1]
+            when 10 then yield :armor,  params[1]
+          end
+        when 121 # Control switches
+          (params[0]..params[1]).each { |id| yield :switch, id }
+        when 122 # Control variables
+          (params[0]..params[1]).each { |id| yield :variable, id }
+          case params[3]
+            when 1 # Variable operand
+              yield :variable, params[4]
+            when 3 # Game data operand
+              kind = GOODS_KINDS[params[4]]
+              yield kind, params[5] if kind
+          end
+        when 125 # Change gold
+          yield :variable, params[2] if params[1] == 1
+        when 126, 127, 128 # Change items, weapons, armors
+          yield GOODS_KINDS[code - 126], params[0]
+          yield :variable, params[3] if params[2] == 1
+        when 201 # Transfer player
+          params[1..3].each { |id| yield :variable, id } if params[0] == 1
+        when 202 # Set vehicle location
+          params[2..4].each { |id| yield :variable, id } if params[1] == 1
+        when 203 # Set event location
+          params[2..3].each { |id| yield :variable, id } if params[1] == 1
+        when 231, 232 # Show picture, move picture
+          params[4..5].each { |id| yield :variable, id } if params[3] == 1
+        when 285 # Get location info
+          yield :variable, params[0]
+          params[3..4].each { |id| yield :variable, id } if params[2] == 1
+        when 301 # Battle processing
+          yield :variable, params[1] if params[0] == 1
+        when 302, 605 # Shop processing
+          kind = GOODS_KINDS[params[0]]
+          yield kind, params[1] if kind
+        when 311, 312, 315, 316, 326 # Change HP, MP, EXP, level, TP
+          yield :variable, params[1] if params[0] == 1
+          yield :variable, params[4] if params[3] == 1
+        when 317 # Change parameters
+          yield :variable, params[1] if params[0] == 1
+          yield :variable, params[5] if params[4] == 1
+        when 331, 332, 342 # Change enemy HP, MP, TP
+          yield :variable, params[3] if params[2] == 1
+        when 313 # Change state
+          yield :variable, params[1] if params[0] == 1
+          yield :state, params[3]
+        when 318 # Change skills
+          yield :variable, params[1] if params[0] == 1
+          yield :skill, params[3]
+        when 319 # Change equipment
+          # The slot kind depends on the actor, which is looked up when the command is scanned.
+          yield equip_kind(@database.actors[params[0]], params[1]), params[2]
+        when 333 # Change enemy state
+          yield :state, params[2]
+        when 339 # Force action
+          yield :skill, params[2]
+      end
+    end
+
+  end
+
+end
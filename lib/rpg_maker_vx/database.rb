@@ -1,5 +1,6 @@
 require 'rpg_maker_rgss3'
 require_relative 'resources/collection'
+require_relative 'cross_reference'
 
 module RPGMakerVX
 
@@ -131,6 +132,14 @@ module RPGMakerVX
     # @return [::RPG::System]
     attr_reader :system
 
+    # Provides a reverse-reference index from IDs to the objects and event commands that use them.
+    # The index is built the first time it is requested,
+    # and is then updated as items are added to and removed from the collections.
+    # @return [CrossReference]
+    def cross_references
+      @cross_references ||= CrossReference.new(self)
+    end
+
     # Creates an database with pre-populated resources.
     # @param resources [Hash{Symbol => [Resources::Collection, ::RPG::System]}]
     def initialize(resources = {})
@@ -8,8 +8,20 @@ module RPGMakerVX
       # Create the base collection.
       # @param type [Class] Expected type of each item.
       def initialize(type)
-        @items = []
-        @type  = type
+        @items     = []
+        @type      = type
+        @listeners = []
+      end
+
+      # Registers a block to be called whenever an item is added to or removed from the collection.
+      # @yieldparam old_item Item that was removed or replaced, or +nil+ if there was none.
+      # @yieldparam new_item Item that was added, or +nil+ if an item was only removed.
+      # @return [self]
+      # @note Changes made directly to an item's attributes are not reported.
+      #   Re-add the item with +#add+ to report them.
+      def on_change(&block)
+        @listeners << block
+        self
       end
 
       # Adds an item to the collection.
@@ -24,6 +36,7 @@ module RPGMakerVX
           item.id = next_free_id
         end
         @items[item.id] = item
+        notify_change(nil, item)
         self
       end
 
@@ -61,7 +74,10 @@ module RPGMakerVX
       # @note If an existing item shares the same ID, it will be overwritten.
       def add(item)
         fail TypeError unless item.kind_of?(@type)
+        previous = @items[item.id]
         @items[item.id] = item
+        notify_change(previous, item)
+        item
       end
 
       # Removes an existing item from the collection.
@@ -69,7 +85,9 @@ module RPGMakerVX
       # @return [Boolean] +true+ if the item was found and removed, or +false+ if it didn't exist in the collection.
       def delete(item)
         if @items.include?(item)
-          @items.delete_at(item.id)
+          # Clear the slot instead of removing it so that the remaining items keep their IDs.
+          @items[item.id] = nil
+          notify_change(item, nil)
           true
         else
           false
@@ -80,15 +98,21 @@ module RPGMakerVX
       # @param id [Fixnum] ID of the item to remove.
       # @return [Boolean] +true+ if the item was found and removed, or +false+ if it didn't exist in the collection.
       def delete_id(id)
-        existed = exist?(id)
+        previous   = @items[id]
         @items[id] = nil
-        existed
+        notify_change(previous, nil) unless previous.nil?
+        !previous.nil?
       end
 
       # Removes all items from the collection.
       # @return [void]
       def clear
-        @items = []
+        previous = @items
+        @items   = []
+        previous.each do |item|
+          notify_change(item, nil) unless item.nil?
+        end
+        nil
       end
 
       # Checks if an item with the specified ID exists.
@@ -153,6 +177,18 @@ module RPGMakerVX
         nil
       end
 
+      private
+
+      # Calls each of the registered change listeners.
+      # @param old_item Item that was removed or replaced, or +nil+.
+      # @param new_item Item that was added, or +nil+.
+      # @return [void]
+      def notify_change(old_item, new_item)
+        @listeners.each do |listener|
+          listener.call(old_item, new_item)
+        end
+      end
+
     end
 
   end
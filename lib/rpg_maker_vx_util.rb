@@ -7,3 +7,4 @@ end
 
 require_relative 'rpg_maker_vx_util/version'
 require_relative 'rpg_maker_vx_util/script_converter'
+require_relative 'rpg_maker_vx_util/database_converter'
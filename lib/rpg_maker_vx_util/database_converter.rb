@@ -0,0 +1,316 @@
+require 'json'
+
+module RPGMakerVXUtil
+
+  # Converts a database between RPG Maker VX format and JSON-based formats.
+  # Items are written and read one at a time, so memory use is bounded by the largest single item,
+  # not by the size of the database.
+  module DatabaseConverter
+
+    # File extension used for JSON-lines files.
+    JSON_LINES_EXTENSION = '.jsonl'.freeze
+
+    # Name of the file containing system data.
+    SYSTEM_FILE_NAME = 'system.json'.freeze
+
+    # Name of the file listing the columns and row count of a collection in columnar format.
+    MANIFEST_FILE_NAME = 'manifest.json'.freeze
+
+    # Key used to store the class name of an encoded object.
+    # This matches the convention used by the json gem and the rgss3 extension.
+    CLASS_KEY = 'json_class'.freeze
+
+    # Classes with native JSON support in the rgss3 extension.
+    NATIVE_CLASSES = [::Table, ::Color, ::Tone].freeze
+
+    # Column value for an item that doesn't have the attribute at all.
+    # This is distinct from +null+, which is an attribute set to +nil+.
+    ABSENT_VALUE = { CLASS_KEY => 'Absent' }.freeze
+
+    class << self
+
+      # Export a database to a directory.
+      # @param database [::RPGMakerVX::Database] Database to export.
+      # @param dest [String] Path to the directory to write to.
+      # @param options [Hash] Additional export options.
+      # @option options [Symbol] :format How the data is stored.
+      #   The options are:
+      #   - +:json_lines+ - Create one file per collection, with one item per line.
+      #   - +:columnar+ - Create one directory per collection, with one file per attribute and one value per line.
+      # @return [void]
+      def export(database, dest, options = { :format => :json_lines })
+        Dir.mkdir(dest) unless Dir.exist?(dest)
+
+        ::RPGMakerVX::Database::COLLECTION_TYPE_MAP.each_key do |key|
+          collection = database.send(key)
+          case(options[:format])
+            when :columnar
+              export_columns(collection, File.join(dest, key.to_s))
+            else # :json_lines
+              export_lines(collection, File.join(dest, key.to_s + JSON_LINES_EXTENSION))
+          end
+        end
+
+        unless database.system.nil?
+          File.open(File.join(dest, SYSTEM_FILE_NAME), 'wb') do |f|
+            f.write JSON.generate(encode(database.system))
+          end
+        end
+        nil
+      end
+
+      # Import a database from a directory created by +#export+.
+      # @param src [String] Path to the directory to read from.
+      # @param options [Hash] Additional import options.
+      # @option options [Symbol] :format How the data is stored.
+      #   Must match the format that was used to export the data.
+      # @return [::RPGMakerVX::Database]
+      def import(src, options = { :format => :json_lines })
+        resources = Hash[::RPGMakerVX::Database::COLLECTION_TYPE_MAP.map do |key, item_type|
+                           collection = case(options[:format])
+                                          when :columnar
+                                            import_columns(File.join(src, key.to_s), item_type)
+                                          else # :json_lines
+                                            import_lines(File.join(src, key.to_s + JSON_LINES_EXTENSION), item_type)
+                                        end
+                           [key, collection]
+                         end]
+
+        sys_path = File.join(src, SYSTEM_FILE_NAME)
+        if File.exist?(sys_path)
+          sys = decode(JSON.parse(File.read(sys_path, :mode => 'rb')))
+          fail TypeError unless sys.kind_of?(::RPG::System)
+          resources[:system] = sys
+        end
+
+        ::RPGMakerVX::Database.new(resources)
+      end
+
+      private
+
+      # Writes a collection to a JSON-lines file.
+      # @param collection [::RPGMakerVX::Resources::Collection] Collection to export.
+      # @param path [String] Path to the file to write.
+      # @return [void]
+      def export_lines(collection, path)
+        File.open(path, 'wb') do |f|
+          collection.each do |item|
+            f.write JSON.generate(encode(item))
+            f.write "\n"
+          end
+        end
+      end
+
+      # Reads a collection from a JSON-lines file.
+      # @param path [String] Path to the file to read.
+      # @param type [Class] Expected type of each item.
+      # @return [::RPGMakerVX::Resources::Collection]
+      def import_lines(path, type)
+        collection = ::RPGMakerVX::Resources::Collection.new(type)
+        return collection unless File.exist?(path)
+
+        File.open(path, 'rb') do |f|
+          f.each_line do |line|
+            next if line.strip.empty?
+            item = decode(JSON.parse(line))
+            fail TypeError unless item.kind_of?(type)
+            collection.add(item)
+          end
+        end
+        collection
+      end
+
+      # Writes a collection to a directory of column files.
+      # Each column file has one line per item, in the same order.
+      # A manifest lists the columns and the number of rows.
+      # @param collection [::RPGMakerVX::Resources::Collection] Collection to export.
+      # @param path [String] Path to the directory to write.
+      # @return [void]
+      def export_columns(collection, path)
+        if Dir.exist?(path)
+          # Remove columns from a previous export so they can't be mistaken for current ones.
+          stale = Dir.glob(File.join(path, '*' + JSON_LINES_EXTENSION))
+          stale << File.join(path, MANIFEST_FILE_NAME)
+          stale.each do |file_path|
+            File.delete(file_path) if File.exist?(file_path)
+          end
+        else
+          Dir.mkdir(path)
+        end
+
+        # Gather the attribute names first, so that each column file can be written in a single pass.
+        names = []
+        collection.each do |item|
+          names |= item.instance_variables
+        end
+
+        absent = JSON.generate(ABSENT_VALUE)
+        rows   = 0
+        files  = Hash[names.map do |name|
+                        file_path = File.join(path, attribute_name(name) + JSON_LINES_EXTENSION)
+                        [name, File.open(file_path, 'wb')]
+                      end]
+        begin
+          collection.each do |item|
+            files.each do |name, f|
+              if item.instance_variable_defined?(name)
+                f.write JSON.generate(encode(item.instance_variable_get(name)), :quirks_mode => true)
+              else
+                f.write absent
+              end
+              f.write "\n"
+            end
+            rows += 1
+          end
+        ensure
+          files.each_value(&:close)
+        end
+
+        # Write the manifest last, so that an interrupted export can't be imported.
+        manifest = { 'columns' => names.map { |name| attribute_name(name) }, 'rows' => rows }
+        File.open(File.join(path, MANIFEST_FILE_NAME), 'wb') do |f|
+          f.write JSON.generate(manifest)
+        end
+      end
+
+      # Reads a collection from a directory of column files.
+      # Only the columns listed in the manifest are read.
+      # @param path [String] Path to the directory to read.
+      # @param type [Class] Expected type of each item.
+      # @return [::RPGMakerVX::Resources::Collection]
+      # @raise [IOError] The manifest is missing, or a column doesn't have the number of rows listed in it.
+      def import_columns(path, type)
+        collection = ::RPGMakerVX::Resources::Collection.new(type)
+        return collection unless Dir.exist?(path)
+
+        manifest_path = File.join(path, MANIFEST_FILE_NAME)
+        fail IOError, "Missing column manifest #{manifest_path}" unless File.exist?(manifest_path)
+        manifest = JSON.parse(File.read(manifest_path, :mode => 'rb'))
+        rows     = manifest['rows']
+
+        files = {}
+        begin
+          manifest['columns'].each do |column|
+            file_path = File.join(path, column + JSON_LINES_EXTENSION)
+            files[('@' + column).to_sym] = File.open(file_path, 'rb')
+          end
+
+          rows.times do |row|
+            item = type.allocate
+            files.each do |name, f|
+              line = f.gets
+              fail IOError, "Column #{f.path} has #{row} rows, expected #{rows}" if line.nil?
+              value = JSON.parse(line, :quirks_mode => true)
+              next if value == ABSENT_VALUE
+              item.instance_variable_set(name, decode(value))
+            end
+            collection.add(item)
+          end
+
+          files.each_value do |f|
+            fail IOError, "Column #{f.path} has more than #{rows} rows" unless f.eof?
+          end
+        ensure
+          files.each_value(&:close)
+        end
+        collection
+      end
+
+      # Converts an object to values that can be written as JSON.
+      # Objects are converted to a hash of their instance variables, tagged with their class name.
+      # Tables, colors, and tones are left as-is, since they are encoded natively.
+      # @param value Object to convert.
+      # @return JSON-compatible value.
+      # @raise [TypeError] The value is an object that +#decode+ can't recreate.
+      def encode(value)
+        case value
+          when nil, true, false, Integer, Float, *NATIVE_CLASSES
+            value
+          when String
+            if value.encoding == Encoding::UTF_8 && value.valid_encoding?
+              value
+            else
+              # JSON strings are always read back as UTF-8, so store the raw bytes and their encoding.
+              { CLASS_KEY => 'String', 'base64' => [value].pack('m0'), 'encoding' => value.encoding.name }
+            end
+          when Symbol
+            { CLASS_KEY => 'Symbol', 'name' => encode(value.to_s) }
+          when Array
+            value.map { |element| encode(element) }
+          when Hash
+            # Keys may not be strings, so store the pairs.
+            { CLASS_KEY => 'Hash', 'pairs' => value.map { |k, v| [encode(k), encode(v)] } }
+          else
+            # Only RPG Maker classes are allowed to be created on import.
+            fail TypeError, "Can't export #{value.class}" unless rpg_class_name?(value.class.name)
+            hash = { CLASS_KEY => value.class.name }
+            value.instance_variables.each do |name|
+              hash[attribute_name(name)] = encode(value.instance_variable_get(name))
+            end
+            hash
+        end
+      end
+
+      # Converts values read from JSON back to objects.
+      # @param value Value parsed from JSON.
+      # @return Decoded object.
+      # @raise [TypeError] The value is tagged with a class that isn't from RPG Maker.
+      def decode(value)
+        case value
+          when Array
+            value.map { |element| decode(element) }
+          when Hash
+            decode_object(value)
+          else
+            value
+        end
+      end
+
+      # Converts a tagged hash read from JSON back to an object.
+      # @param hash [Hash] Hash parsed from JSON.
+      # @return Decoded object.
+      def decode_object(hash)
+        class_name = hash[CLASS_KEY]
+        case class_name
+          when 'String'
+            string   = hash['base64'].unpack('m0').first
+            encoding = hash['encoding']
+            encoding ? string.force_encoding(encoding) : string
+          when 'Symbol'
+            decode(hash['name']).to_sym
+          when 'Hash'
+            Hash[hash['pairs'].map { |k, v| [decode(k), decode(v)] }]
+          else
+            klass = NATIVE_CLASSES.find { |native| native.name == class_name }
+            return klass.json_create(hash) if klass
+
+            # Only allow RPG Maker classes to be created.
+            fail TypeError, "Unexpected class #{class_name.inspect}" unless rpg_class_name?(class_name)
+            obj = Object.const_get(class_name).allocate
+            hash.each do |name, value|
+              next if name == CLASS_KEY
+              obj.instance_variable_set('@' + name, decode(value))
+            end
+            obj
+        end
+      end
+
+      # Checks whether a class name refers to an RPG Maker class.
+      # @param class_name [String, nil] Name of the class.
+      # @return [Boolean]
+      def rpg_class_name?(class_name)
+        class_name.to_s.start_with?('RPG::')
+      end
+
+      # Converts an instance variable name to an attribute name.
+      # @param name [Symbol] Instance variable name, such as +:@id+.
+      # @return [String] Attribute name, such as +'id'+.
+      def attribute_name(name)
+        name.to_s[1..-1]
+      end
+
+    end
+
+  end
+
+end
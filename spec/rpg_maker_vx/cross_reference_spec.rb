@@ -0,0 +1,120 @@
+require_relative '../spec_helper'
+
+RSpec.describe RPGMakerVX::CrossReference do
+
+  let(:database) { RPGMakerVX::Database.new }
+
+  context 'with a troop' do
+    let(:troop) do
+      troop = ::RPG::Troop.new
+      troop.id = 1
+      page = troop.pages.first
+      page.condition.switch_valid = true
+      page.condition.switch_id    = 3
+      page.list = [
+          ::RPG::EventCommand.new(121, 0, [5, 5, 0]),  # Control switches
+          ::RPG::EventCommand.new(313, 0, [0, 1, 0, 7]), # Change state
+          ::RPG::EventCommand.new
+      ]
+      troop
+    end
+
+    before(:each) do
+      database.troops << troop
+    end
+
+    subject { database.cross_references }
+
+    it 'indexes the page condition switch' do
+      refs = subject.references(:switch, 3)
+      expect(refs.size).to eq(1)
+      expect(refs.first.collection).to eq(:troops)
+      expect(refs.first.item).to equal(troop)
+      expect(refs.first.command).to be_nil
+    end
+
+    it 'indexes the page event commands' do
+      refs = subject.references(:state, 7)
+      expect(refs.size).to eq(1)
+      expect(refs.first.command.code).to eq(313)
+      expect(subject.referenced?(:switch, 5)).to be true
+    end
+
+    it 'removes the troop when it is deleted' do
+      subject
+      database.troops.delete_id(troop.id)
+      expect(subject.referenced?(:switch, 3)).to be false
+      expect(subject.referenced?(:state, 7)).to be false
+    end
+  end
+
+  context 'with an item in more than one slot' do
+    let(:skill) do
+      skill = ::RPG::Skill.new
+      skill.id = 1
+      skill.effects = [::RPG::UsableItem::Effect.new(21, 4)] # Add state
+      skill
+    end
+
+    subject { database.cross_references }
+
+    before(:each) do
+      database.skills << skill
+      subject
+      database.skills << skill # Taken ID, so it's placed in a new slot.
+    end
+
+    it 'references the item once' do
+      expect(subject.references(:state, 4).size).to eq(1)
+    end
+
+    it 'keeps the item while another slot holds it' do
+      database.skills.delete_id(1)
+      expect(subject.referenced?(:state, 4)).to be true
+    end
+
+    it 'removes the item once no slots hold it' do
+      database.skills.delete_id(1)
+      database.skills.delete_id(2)
+      expect(subject.referenced?(:state, 4)).to be false
+    end
+  end
+
+  context 'with equipment commands' do
+    let(:actor) do
+      actor = ::RPG::Actor.new
+      actor.id = 1
+      actor.features = [::RPG::BaseItem::Feature.new(55, 1)] # Dual wield
+      actor
+    end
+
+    let(:event) do
+      event = ::RPG::CommonEvent.new
+      event.id = 1
+      event.list = [
+          ::RPG::EventCommand.new(319, 0, [1, 1, 6]), # Change equipment, second slot
+          ::RPG::EventCommand.new(319, 0, [2, 1, 8]), # Change equipment, second slot
+          ::RPG::EventCommand.new
+      ]
+      event
+    end
+
+    before(:each) do
+      database.actors << actor
+      database.common_events << event
+    end
+
+    subject { database.cross_references }
+
+    it 'indexes the second slot as a weapon for dual wielding actors' do
+      expect(subject.referenced?(:weapon, 6)).to be true
+      expect(subject.referenced?(:armor, 6)).to be false
+    end
+
+    it 'indexes the second slot as armor for other actors' do
+      expect(subject.referenced?(:armor, 8)).to be true
+      expect(subject.referenced?(:weapon, 8)).to be false
+    end
+  end
+
+end